@@ -3,6 +3,8 @@
 .EQU	kioTrap,	 6
 .EQU	kioResult,	16
 .EQU	kcsCode,	26
+.EQU	kdCtlQHead,	 8
+.EQU	kRBDefer,	 1
 .EQU	JIODone,	0x08FC
 
 dc.l	0x00000000, 0x00000000, 0x00000000, 0x00000000
@@ -29,6 +31,10 @@ RDiskRAMRequired:
 .align 4
 RDiskSize:
 dc.l 0x00780000
+RBRAMDiskStart:
+dc.l 0x00000000
+RBRAMDiskSize:
+dc.l 0x00780000
 
 DOpen:
 	movem.l		%A0-%A1, -(%SP)
@@ -46,7 +52,9 @@ DPrime:
 	movem.l		%A0-%A1, -(%SP)
 	bsr			RBPrime
 	movem.l		(%SP)+, %A0-%A1
-	bra.b		IOReturn
+	cmpi.w		#kRBDefer, %D0
+	bne.b		IOReturn
+	rts			* Left in queue, finished later by RBResume
 
 DControl:
 	movem.l		%A0-%A1, -(%SP)
@@ -78,3 +86,23 @@ ImmedRTS:
 Queued:
 	move.l		JIODone, -(%SP)
 	rts
+
+* Redo prime call deferred while card was busy, then complete it
+* Nothing to do if the queue was flushed meanwhile
+* A1 - DCtlPtr
+.global RBResume
+RBResume:
+	movem.l		%D2-%D7/%A2-%A6, -(%SP)
+	move.l		kdCtlQHead(%A1), %D0
+	beq.b		ResumeDone
+	movea.l		%D0, %A0
+	movem.l		%A0-%A1, -(%SP)
+	bsr			RBPrime
+	movem.l		(%SP)+, %A0-%A1
+	cmpi.w		#kRBDefer, %D0
+	beq.b		ResumeDone
+	movea.l		JIODone, %A0
+	jsr			(%A0)
+ResumeDone:
+	movem.l		(%SP)+, %D2-%D7/%A2-%A6
+	rts
@@ -6,8 +6,9 @@
 #include <Events.h>
 #include <OSUtils.h>
 
-#include "rombus.h"
 #include "spi.h"
+#include "sd.h"
+#include "rombus.h"
 #include "priv_syscall.h"
 
 // Decode keyboard settings
@@ -54,6 +55,7 @@ static OSErr RBDecodePRAMSettings(RBStorage_t *c) {
 	const char opt_boot_rom  = legacy_startup & (1<<0);
 	const char opt_mount_sd  = legacy_startup & (1<<3);
 	const char opt_mount_rom = legacy_startup & (1<<4);
+	const char opt_ram_sd    = legacy_ram & (1<<1);
 
 	// Old settings for ROM SIMM (not used here)
 	//const char opt_old_mount_rom = !(legacy_startup & (1<<1));
@@ -66,6 +68,7 @@ static OSErr RBDecodePRAMSettings(RBStorage_t *c) {
 		c->unmountSDEN = !opt_boot_sd;
 		c->mountROMEN = opt_mount_rom && !opt_boot_rom;
 		c->mountSDEN = opt_mount_sd && !opt_boot_sd;
+		c->ramEN = opt_ram_sd;
 	}
 	return noErr;
 }
@@ -79,10 +82,381 @@ void __attribute__ ((noinline)) C24(Ptr sourcePtr, Ptr destPtr, unsigned long by
 	SwapMMUMode(&mode);
 }
 
+// Disable interrupts while rearranging the driver queue
+static inline short RBIntsOff() {
+	short sr;
+	__asm__ __volatile__ ("move.w %%sr, %0\n\tori.w #0x0700, %%sr" : "=d" (sr) : : "memory");
+	return sr;
+}
+static inline void RBIntsRestore(short sr) {
+	__asm__ __volatile__ ("move.w %0, %%sr" : : "d" (sr) : "memory");
+}
+
+// Finishes a prime call deferred while the card was busy (entry.s)
+#pragma parameter RBResume(__A1)
+extern void RBResume(DCtlPtr d);
+
+// Claim the card for p. If another transfer holds it, returns 0 and a
+// queued p is deferred until the card is released.
+static char RBCardAcquire(IOParamPtr p, DCtlPtr d, RBStorage_t *c) {
+	short sr = RBIntsOff();
+	char ok = !c->cardBusy;
+	if (ok) { c->cardBusy = 1; }
+	else if (!(p->ioTrap & RB_TRAP_IMMED)) {
+		c->cardDeferred = 1;
+		c->deferredPos = d->dCtlPosition;
+	}
+	RBIntsRestore(sr);
+	return ok;
+}
+
+// Release the card and run the prime call deferred meanwhile, if any
+static void RBCardRelease(DCtlPtr d, RBStorage_t *c) {
+	short sr = RBIntsOff();
+	char deferred = c->cardDeferred;
+	c->cardBusy = 0;
+	c->cardDeferred = 0;
+	RBIntsRestore(sr);
+	if (deferred && d->dCtlQHdr.qHead) {
+		d->dCtlPosition = c->deferredPos;
+		RBResume(d);
+	}
+}
+
+static inline char RBIsWrite(IOParamPtr q) { return (q->ioTrap & 0xFF) == RB_TRAP_WRITE; }
+static inline unsigned long RBBlock(IOParamPtr q) { return q->ioPosOffset / RB_BLOCK_SIZE; }
+static inline unsigned long RBCount(IOParamPtr q) { return q->ioReqCount / RB_BLOCK_SIZE; }
+
+// Check whether a pending request may be reordered or merged
+static char RBSchedEligible(RBStorage_t *c, IOParamPtr q) {
+	char trap = q->ioTrap & 0xFF;
+	if (trap != RB_TRAP_READ && trap != RB_TRAP_WRITE) { return 0; }
+	// Only absolute positions are independent of the requests ahead
+	if ((q->ioPosMode & 3) != fsFromStart) { return 0; }
+	if (q->ioReqCount <= 0 || q->ioPosOffset < 0) { return 0; }
+	if ((q->ioPosOffset | q->ioReqCount) & (RB_BLOCK_SIZE - 1)) { return 0; }
+	if (RBBlock(q) + RBCount(q) > c->sdSize / RB_BLOCK_SIZE) { return 0; }
+	if (RBIsWrite(q) && c->sdStatus.writeProt) { return 0; }
+	for (int i = 0; i < RB_MERGE_MAX; i++) {
+		if (c->done[i] == q) { return 0; }
+	}
+	return 1;
+}
+
+// Check whether q reads/writes relative to where the request before it ended
+static char RBSchedIsMarkRel(IOParamPtr q) {
+	char trap = q->ioTrap & 0xFF;
+	if (trap != RB_TRAP_READ && trap != RB_TRAP_WRITE) { return 0; }
+	return (q->ioPosMode & 3) != fsFromStart;
+}
+
+// Order x ahead of y if it comes first in the sweep and the swap is safe
+static char RBSchedBefore(IOParamPtr x, IOParamPtr y, unsigned long pivot) {
+	unsigned long xb = RBBlock(x), yb = RBBlock(y);
+	// Requests overlapping a write keep their order
+	if ((RBIsWrite(x) || RBIsWrite(y)) &&
+		xb < yb + RBCount(y) && yb < xb + RBCount(x)) { return 0; }
+	// Ascending from pivot, wrapping around to the lowest block
+	return xb - pivot < yb - pivot;
+}
+
+// Sort requests queued behind p into elevator order
+static void RBSchedSort(DCtlPtr d, RBStorage_t *c, IOParamPtr p, unsigned long pivot) {
+	IOParamPtr run[RB_SCHED_MAX];
+	IOParamPtr prev = p, q = (IOParamPtr)p->qLink;
+	int n, i, j;
+
+	while (q) {
+		// Collect requests up to the next one that can't be moved
+		for (n = 0; q && n < RB_SCHED_MAX && RBSchedEligible(c, q); n++) {
+			run[n] = q;
+			q = (IOParamPtr)q->qLink;
+		}
+
+		// Insertion sort keeps order of requests that can't be swapped.
+		// Leave run as is if a mark-relative request depends on its end.
+		for (i = 1; i < n && !(q && RBSchedIsMarkRel(q)); i++) {
+			IOParamPtr x = run[i];
+			for (j = i; j > 0 && RBSchedBefore(x, run[j - 1], pivot); j--) {
+				run[j] = run[j - 1];
+			}
+			run[j] = x;
+		}
+
+		// Relink sorted requests into queue
+		for (i = 0; i < n; i++) {
+			prev->qLink = (QElemPtr)run[i];
+			prev = run[i];
+		}
+		prev->qLink = (QElemPtr)q;
+		if (!q) { d->dCtlQHdr.qTail = (QElemPtr)prev; }
+		else if (n < RB_SCHED_MAX) { // Step over unmovable request
+			prev = q;
+			q = (IOParamPtr)q->qLink;
+		}
+	}
+}
+
+// Remove p from the list of requests already serviced, if present
+static char RBSchedTakeDone(RBStorage_t *c, IOParamPtr p) {
+	for (int i = 0; i < RB_MERGE_MAX; i++) {
+		if (c->done[i] == p) {
+			c->done[i] = NULL;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void RBSchedPutDone(RBStorage_t *c, IOParamPtr p) {
+	for (int i = 0; i < RB_MERGE_MAX; i++) {
+		if (!c->done[i]) {
+			c->done[i] = p;
+			return;
+		}
+	}
+}
+
+// Transfer p along with any adjacent requests queued right behind it
+static OSErr RBSchedRun(IOParamPtr p, DCtlPtr d, RBStorage_t *c) {
+	IOParamPtr batch[RB_MERGE_MAX];
+	char write = RBIsWrite(p);
+	unsigned long block = d->dCtlPosition / RB_BLOCK_SIZE;
+	unsigned long end = block + RBCount(p);
+	int n = 1, i;
+	short sr;
+
+	batch[0] = p;
+
+	// Reorder queue and gather batch while nothing can be enqueued.
+	// Immediate calls aren't in the queue, their qLink is meaningless.
+	if (d->dCtlQHdr.qHead == (QElemPtr)p && !(p->ioTrap & RB_TRAP_IMMED)) {
+		sr = RBIntsOff();
+		RBSchedSort(d, c, p, end);
+		for (IOParamPtr q = (IOParamPtr)p->qLink; q && n < RB_MERGE_MAX; q = (IOParamPtr)q->qLink) {
+			if (!RBSchedEligible(c, q) || RBIsWrite(q) != write || RBBlock(q) != end) { break; }
+			batch[n++] = q;
+			end += RBCount(q);
+		}
+		RBIntsRestore(sr);
+	}
+
+	// Stream whole batch with one multi-block command
+	if (write ? sd_write_start(&c->card, c->sdStart + block) :
+				sd_read_start(&c->card, c->sdStart + block)) { return ioErr; }
+	for (i = 0; i < n; i++) {
+		Ptr buf = batch[i]->ioBuffer;
+		if (write ? sd_write_next(&c->card, buf, RBCount(batch[i])) :
+					sd_read_next(&c->card, buf, RBCount(batch[i]))) { break; }
+	}
+	if (write ? sd_write_stop(&c->card) : sd_read_stop(&c->card)) { i = 0; }
+
+	// Keep RAM disk copy in step with card
+	if (write && c->ramBuf) {
+		for (int j = 0; j < i; j++) {
+			long pos = j ? batch[j]->ioPosOffset : d->dCtlPosition;
+			BlockMove(batch[j]->ioBuffer, c->ramBuf + pos, batch[j]->ioReqCount);
+		}
+	}
+
+	// Merged requests complete through their own prime call at queue head
+	for (int j = 1; j < i; j++) { RBSchedPutDone(c, batch[j]); }
+	return i > 0 ? noErr : ioErr;
+}
+
+static inline char RBRAMIsLoaded(RBStorage_t *c, unsigned long chunk) {
+	return c->ramLoaded[chunk >> 3] & (1 << (chunk & 7));
+}
+static inline void RBRAMSetLoaded(RBStorage_t *c, unsigned long chunk) {
+	c->ramLoaded[chunk >> 3] |= 1 << (chunk & 7);
+}
+
+static char RBRAMIsLoadedRange(RBStorage_t *c, unsigned long first, unsigned long last) {
+	for (; first < last; first++) {
+		if (!RBRAMIsLoaded(c, first)) { return 0; }
+	}
+	return 1;
+}
+
+// Queue chunk ahead of background load, most recent first
+static void RBRAMPushPrio(RBStorage_t *c, unsigned long chunk) {
+	int i;
+	for (i = 0; i < c->ramPrioCount; i++) {
+		if (c->ramPrio[i] == chunk) { return; }
+	}
+	// Drop oldest entry if full
+	if (c->ramPrioCount == RB_RAM_PRIO_MAX) {
+		for (i = 1; i < RB_RAM_PRIO_MAX; i++) { c->ramPrio[i - 1] = c->ramPrio[i]; }
+		c->ramPrioCount--;
+	}
+	c->ramPrio[c->ramPrioCount++] = chunk;
+}
+
+// In RAM disk mode the disk is the image extent given in driver header.
+// Disk stays offline if the extent doesn't fit on the card.
+static void RBRAMSetExtent(RBStorage_t *c) {
+	unsigned long start = RBRAMDiskStart, size = RBRAMDiskSize;
+	if (size == 0 || (size & (RB_BLOCK_SIZE - 1)) ||
+		start + size / RB_BLOCK_SIZE > c->sdSize / RB_BLOCK_SIZE) {
+		c->sdSize = 0;
+		c->mountPending = 0;
+		return;
+	}
+	c->sdStart = start;
+	c->sdSize = size;
+}
+
+// Allocate RAM disk buffer for the extent.
+// If that fails, the same extent is read from SD directly.
+static void RBRAMInit(RBStorage_t *c) {
+	unsigned long size = c->sdSize;
+	if (size == 0 || c->ramBuf) { return; }
+
+	c->ramChunks = (size / RB_BLOCK_SIZE + RB_RAM_CHUNK - 1) / RB_RAM_CHUNK;
+	c->ramNext = 0;
+	c->ramLoaded = NewPtrSysClear((c->ramChunks + 7) / 8);
+	if (!c->ramLoaded) { return; }
+	c->ramBuf = NewPtrSys(size);
+	if (!c->ramBuf) {
+		DisposePtr(c->ramLoaded);
+		c->ramLoaded = NULL;
+	}
+}
+
+static void RBRAMFree(RBStorage_t *c) {
+	if (c->ramBuf) { DisposePtr(c->ramBuf); }
+	if (c->ramLoaded) { DisposePtr(c->ramLoaded); }
+	c->ramBuf = NULL;
+	c->ramLoaded = NULL;
+}
+
+// Copy chunks in [first, last) not yet in RAM from SD, one stream per run
+static OSErr RBRAMFill(RBStorage_t *c, unsigned long first, unsigned long last) {
+	unsigned long blocks = c->sdSize / RB_BLOCK_SIZE;
+	unsigned long i = first, start, b0, b1;
+	int err;
+
+	while (i < last) {
+		if (RBRAMIsLoaded(c, i)) { i++; continue; }
+
+		// Find run of chunks still to load
+		for (start = i; i < last && !RBRAMIsLoaded(c, i); i++) { }
+		b0 = start * RB_RAM_CHUNK;
+		b1 = i * RB_RAM_CHUNK;
+		if (b1 > blocks) { b1 = blocks; }
+
+		if (sd_read_start(&c->card, c->sdStart + b0)) { return ioErr; }
+		err = sd_read_next(&c->card, c->ramBuf + b0 * RB_BLOCK_SIZE, b1 - b0);
+		if (sd_read_stop(&c->card) || err) { return ioErr; }
+
+		for (; start < i; start++) { RBRAMSetLoaded(c, start); }
+	}
+	return noErr;
+}
+
+// Check whether blocks [block, block+count) are all in RAM
+static char RBRAMHas(RBStorage_t *c, unsigned long block, unsigned long count) {
+	return RBRAMIsLoadedRange(c, block / RB_RAM_CHUNK,
+		(block + count + RB_RAM_CHUNK - 1) / RB_RAM_CHUNK);
+}
+
+// Read from RAM disk if loaded, else straight from SD
+static OSErr RBRAMRead(IOParamPtr p, DCtlPtr d, RBStorage_t *c) {
+	unsigned long blocks = c->sdSize / RB_BLOCK_SIZE;
+	unsigned long block = d->dCtlPosition / RB_BLOCK_SIZE;
+	unsigned long count = RBCount(p);
+	unsigned long first = block / RB_RAM_CHUNK;
+	unsigned long last = (block + count + RB_RAM_CHUNK - 1) / RB_RAM_CHUNK;
+	unsigned long k, b0, b1;
+	int err;
+
+	if (RBRAMHas(c, block, count)) {
+		BlockMove(c->ramBuf + d->dCtlPosition, p->ioBuffer, p->ioReqCount);
+		return noErr;
+	}
+
+	// Read only requested blocks from card
+	if (sd_read_start(&c->card, c->sdStart + block)) { return ioErr; }
+	err = sd_read_next(&c->card, p->ioBuffer, count);
+	if (sd_read_stop(&c->card) || err) { return ioErr; }
+
+	// Keep chunks read in full, load partly read ones next
+	for (k = first; k < last; k++) {
+		if (RBRAMIsLoaded(c, k)) { continue; }
+		b0 = k * RB_RAM_CHUNK;
+		b1 = b0 + RB_RAM_CHUNK;
+		if (b1 > blocks) { b1 = blocks; }
+		if (b0 >= block && b1 <= block + count) {
+			BlockMove(p->ioBuffer + (b0 - block) * RB_BLOCK_SIZE,
+				c->ramBuf + b0 * RB_BLOCK_SIZE, (b1 - b0) * RB_BLOCK_SIZE);
+			RBRAMSetLoaded(c, k);
+		} else { RBRAMPushPrio(c, k); }
+	}
+	return noErr;
+}
+
+// Load next few chunks of RAM disk in the background
+static void RBRAMLoadNext(RBStorage_t *c) {
+	unsigned long first = c->ramChunks, last;
+
+	// Chunks partly read from card go first
+	while (c->ramPrioCount > 0 && first == c->ramChunks) {
+		unsigned long k = c->ramPrio[--c->ramPrioCount];
+		if (!RBRAMIsLoaded(c, k)) { first = k; }
+	}
+
+	if (first < c->ramChunks) { last = first + 1; }
+	else {
+		// Skip over chunks already loaded by reads
+		while (c->ramNext < c->ramChunks && RBRAMIsLoaded(c, c->ramNext)) { c->ramNext++; }
+		if (c->ramNext >= c->ramChunks) { return; }
+
+		first = c->ramNext;
+		last = first + RB_RAM_LOAD_CHUNKS;
+		if (last > c->ramChunks) { last = c->ramChunks; }
+		c->ramNext = last;
+	}
+
+	// On error stop background load, reads still go to card
+	if (RBRAMFill(c, first, last) != noErr) {
+		c->ramNext = c->ramChunks;
+		c->ramPrioCount = 0;
+	}
+}
+
+// Run background load from accRun unless requests are waiting on the card.
+// Prime calls that need the card meanwhile are deferred until it's done.
+static void RBRAMLoadIdle(CntrlParamPtr p, DCtlPtr d, RBStorage_t *c) {
+	short sr = RBIntsOff();
+	QElemPtr head = d->dCtlQHdr.qHead;
+	if ((head && head != (QElemPtr)p) || c->cardBusy) {
+		RBIntsRestore(sr);
+		return;
+	}
+	c->cardBusy = 1;
+	RBIntsRestore(sr);
+
+	RBRAMLoadNext(c);
+	RBCardRelease(d, c);
+}
+
+// Enable accRun while mount is pending or RAM disk is still loading
+static void RBSetAccRun(DCtlPtr d, RBStorage_t *c) {
+	if (c->mountPending) {
+		d->dCtlFlags |= dNeedTimeMask;
+		d->dCtlDelay = 150; // (150 ticks is 2.5 sec.)
+	} else if (c->ramBuf && c->sdStatus.diskInPlace &&
+			   (c->ramNext < c->ramChunks || c->ramPrioCount > 0)) {
+		d->dCtlFlags |= dNeedTimeMask;
+		d->dCtlDelay = 0; // Every SystemTask
+	} else { d->dCtlFlags &= ~dNeedTimeMask; }
+}
+
 #pragma parameter __D0 RBClose(__A0, __A1)
 OSErr RBClose(IOParamPtr p, DCtlPtr d) {
 	// If dCtlStorage not null, dispose of it
 	if (!d->dCtlStorage) { return noErr; }
+	RBRAMFree(*(RBStorage_t**)d->dCtlStorage);
 	HUnlock(d->dCtlStorage);
 	DisposeHandle(d->dCtlStorage);
 	d->dCtlStorage = NULL;
@@ -111,22 +485,27 @@ OSErr RBOpen(IOParamPtr p, DCtlPtr d) {
 		return openErr;
 	}
 
-	// Iff mount enabled, enable accRun to post disk inserted event later
-	if (c->mountROMEN || c->mountSDEN) { d->dCtlFlags |= dNeedTimeMask; }
-	else { d->dCtlFlags &= ~dNeedTimeMask; }
-
-	// Set accRun delay
-	d->dCtlDelay = 150; // (150 ticks is 2.5 sec.)
+	// Iff mount enabled, post disk inserted event later from accRun
+	c->mountPending = c->mountROMEN || c->mountSDEN;
 
 	// Find first available drive number
 	drvNum = PSFindDrvNum();
 
-	//TODO: set c->sdSize
+	// Bring up SD card and get its size, disk stays offline if that fails
+	if (spi_init(&c->spi, 0) == 0 && sd_init(&c->card, &c->spi) == 0) {
+		c->sdSize = (long long)c->card.blocks * RB_BLOCK_SIZE;
+	} else { c->mountPending = 0; }
+
+	// Set up RAM disk if enabled, only allocate if SD disk will be mounted
+	if (c->ramEN) {
+		RBRAMSetExtent(c);
+		if (!c->unmountSDEN || c->mountSDEN) { RBRAMInit(c); }
+	}
 	
 	// Set drive status
 	c->sdStatus.track = 0;
 	c->sdStatus.writeProt = 0; // nonzero is write protected
-	c->sdStatus.diskInPlace = 8; // 8 is nonejectable disk
+	c->sdStatus.diskInPlace = c->sdSize > 0 ? 8 : 0; // 8 is nonejectable disk
 	c->sdStatus.installed = 1; // drive installed
 	c->sdStatus.sides = 0;
 	c->sdStatus.qType = 1;
@@ -136,6 +515,9 @@ OSErr RBOpen(IOParamPtr p, DCtlPtr d) {
 	c->sdStatus.driveSize = c->sdSize / 512;
 	c->sdStatus.driveS1 = (c->sdSize / 512) >> 16;
 
+	// Background load depends on disk being in place
+	RBSetAccRun(d, c);
+
 	// Decompress icon
 	#ifdef RB_COMPRESS_ICON_ENABLE
 	char *src = &SDIconCompressed[0];
@@ -159,13 +541,21 @@ static void RBBootInit(IOParamPtr p, DCtlPtr d, RBStorage_t *c) {
 	// Unmount if not booting from ROM disk
 	if (c->unmountSDEN) { c->sdStatus.diskInPlace = 0; }
 
-	// Iff mount disabled, disable accRun
-	if (!c->mountSDEN || !c->mountROMEN) { d->dCtlFlags &= ~dNeedTimeMask; }
+	// Iff mount disabled, cancel pending mount
+	if (!c->mountSDEN || !c->mountROMEN) { c->mountPending = 0; }
+
+	// Release RAM disk if SD disk won't be mounted after all,
+	// allocate it if key settings mount a disk RBOpen expected unmounted
+	if (!c->sdStatus.diskInPlace && !c->mountPending) { RBRAMFree(c); }
+	else if (c->ramEN) { RBRAMInit(c); }
+	RBSetAccRun(d, c);
 }
 
 #pragma parameter __D0 RBPrime(__A0, __A1)
 OSErr RBPrime(IOParamPtr p, DCtlPtr d) {
 	RBStorage_t *c;
+	OSErr err;
+	char needsCard;
 
 	// Return disk offline error if dCtlStorage null
 	if (!d->dCtlStorage) { return notOpenErr; }
@@ -178,7 +568,43 @@ OSErr RBPrime(IOParamPtr p, DCtlPtr d) {
 	// Return disk offline error if virtual disk not inserted
 	if (!c->sdStatus.diskInPlace) { return offLinErr; }
 
-	//TODO: Read/write
+	// Skip transfer if already done as part of an earlier merged request
+	if (p->ioReqCount > 0 && !RBSchedTakeDone(c, p)) {
+		// Only whole blocks within the disk can be transferred
+		if (d->dCtlPosition < 0 ||
+			((d->dCtlPosition | p->ioReqCount) & (RB_BLOCK_SIZE - 1)) ||
+			d->dCtlPosition + p->ioReqCount > c->sdSize) {
+			p->ioActCount = 0;
+			return paramErr;
+		}
+		if (RBIsWrite(p) && c->sdStatus.writeProt) {
+			p->ioActCount = 0;
+			return wPrErr;
+		}
+		// Wait for card if another transfer has it, unless data is in RAM
+		needsCard = !(c->ramBuf && !RBIsWrite(p) &&
+			RBRAMHas(c, d->dCtlPosition / RB_BLOCK_SIZE, RBCount(p)));
+		if (needsCard && !RBCardAcquire(p, d, c)) {
+			// Immediate calls can't be left in the queue
+			if (p->ioTrap & RB_TRAP_IMMED) {
+				p->ioActCount = 0;
+				return ioErr;
+			}
+			return RB_DEFER;
+		}
+
+		if (c->ramBuf && !RBIsWrite(p)) { err = RBRAMRead(p, d, c); }
+		else { err = RBSchedRun(p, d, c); }
+		if (err != noErr) { p->ioActCount = 0; }
+		else {
+			d->dCtlPosition += p->ioReqCount;
+			p->ioActCount = p->ioReqCount;
+		}
+
+		// Deferred call may run on release, so finish with position first
+		if (needsCard) { RBCardRelease(d, c); }
+		return err;
+	}
 
 	// Update count and position/offset, then return
 	d->dCtlPosition += p->ioReqCount;
@@ -205,10 +631,13 @@ OSErr RBCtl(CntrlParamPtr p, DCtlPtr d) {
 			if (!c->sdStatus.diskInPlace) { return controlErr; }
 			return noErr;
 		case accRun:
-			c->initialized = 1; // Mark init done
-			c->sdStatus.diskInPlace = 8; // 8 is nonejectable disk
-			PostEvent(diskEvt, c->sdStatus.dQDrive); // Post disk inserted event
-			d->dCtlFlags &= ~dNeedTimeMask; // Disable accRun
+			if (c->mountPending) {
+				c->mountPending = 0;
+				c->initialized = 1; // Mark init done
+				c->sdStatus.diskInPlace = 8; // 8 is nonejectable disk
+				PostEvent(diskEvt, c->sdStatus.dQDrive); // Post disk inserted event
+			} else if (c->ramBuf && c->sdStatus.diskInPlace) { RBRAMLoadIdle(p, d, c); }
+			RBSetAccRun(d, c); // Disable accRun once nothing is left to do
 			return noErr;
 		case kDriveIcon: case kMediaIcon: // Get icon
 			#ifdef RB_COMPRESS_ICON_ENABLE
@@ -227,7 +656,11 @@ OSErr RBCtl(CntrlParamPtr p, DCtlPtr d) {
 		case 24: // Return SCSI partition size
 			*(long*)p->csParam = c->sdSize / 512;
 			return noErr;
-		case killCode: return noErr;
+		case killCode:
+			// Queued requests are being flushed, forget merged and deferred ones
+			for (int i = 0; i < RB_MERGE_MAX; i++) { c->done[i] = NULL; }
+			c->cardDeferred = 0;
+			return noErr;
 		case kEject:
 			// "Reinsert" disk if ejected illegally
 			if (c->sdStatus.diskInPlace) { 
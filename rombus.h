@@ -9,6 +9,8 @@
 #define RDiskDBGDisByte (*(const char*)0x40851DA8)
 #define RDiskCDRDisByte (*(const char*)0x40851DA9)
 #define RDiskSize (*(const unsigned long*)0x40851DAC)
+#define RBRAMDiskStart (*(const unsigned long*)0x40851DB0) // SD block
+#define RBRAMDiskSize (*(const unsigned long*)0x40851DB4) // Bytes
 
 #define RB_COMPRESS_ICON_ENABLE
 
@@ -16,12 +18,48 @@ static inline char IsRPressed() { return *((volatile char*)0x175) & 0x80; }
 static inline char IsSPressed() { return *((volatile char*)0x174) & 0x02; }
 static inline char IsXPressed() { return *((volatile char*)0x174) & 0x80; }
 
+// Low byte of ioTrap for queued read/write requests
+#define RB_TRAP_READ  (0x02)
+#define RB_TRAP_WRITE (0x03)
+#define RB_TRAP_IMMED (0x0200) // noQueueBit
+
+// RBPrime result: request stays queued until RBResume (see entry.s)
+#define RB_DEFER (1)
+
+#define RB_BLOCK_SIZE (512)
+#define RB_SCHED_MAX  (16) // Max pending requests reordered at once
+#define RB_MERGE_MAX  (8)  // Max requests merged into one SD command
+
+#define RB_RAM_CHUNK       (32) // Blocks per RAM disk load unit
+#define RB_RAM_LOAD_CHUNKS (2)  // Chunks loaded per accRun
+#define RB_RAM_PRIO_MAX    (8)  // Chunks queued ahead of background load
+
 #define RB_ICON_SIZE (285)
 typedef struct RDiskStorage_s {
 	DrvSts2 sdStatus;
+	spi_state_t spi;
+	sd_card_t card;
 	long long sdSize;
+	unsigned long sdStart; // First SD block of disk
+
+	// Queued requests already serviced by a merged transfer
+	IOParamPtr done[RB_MERGE_MAX];
+
+	volatile char cardBusy; // A transfer or background load is using the card
+	volatile char cardDeferred; // Queued prime call waiting for the card
+	long deferredPos; // dCtlPosition of deferred call
+
+	// RAM disk copy of image on SD, loaded progressively
+	Ptr ramBuf;
+	Ptr ramLoaded; // One bit per chunk already in RAM
+	unsigned long ramChunks;
+	unsigned long ramNext; // Next chunk for background load
+	unsigned long ramPrio[RB_RAM_PRIO_MAX]; // Chunks touched by reads
+	int ramPrioCount;
 
 	char initialized;
+	char mountPending;
+	char ramEN;
 
 	char unmountSDEN;
 	char mountSDEN;
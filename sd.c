@@ -0,0 +1,202 @@
+#include "sd.h"
+#include "spi.h"
+
+#define SD_CMD_GO_IDLE_STATE        (0)
+#define SD_CMD_SEND_IF_COND         (8)
+#define SD_CMD_SEND_CSD             (9)
+#define SD_CMD_STOP_TRANSMISSION    (12)
+#define SD_CMD_READ_MULTIPLE_BLOCK  (18)
+#define SD_CMD_WRITE_MULTIPLE_BLOCK (25)
+#define SD_CMD_APP_CMD              (55)
+#define SD_CMD_READ_OCR             (58)
+#define SD_ACMD_SD_SEND_OP_COND     (41)
+
+#define SD_R1_IDLE                  (0x01)
+#define SD_TOKEN_START_BLOCK        (0xFE)
+#define SD_TOKEN_START_MULTI_WRITE  (0xFC)
+#define SD_TOKEN_STOP_TRAN          (0xFD)
+#define SD_DATA_RESP_MASK           (0x1F)
+#define SD_DATA_RESP_ACCEPTED       (0x05)
+
+// Chip select is active-low
+#define SD_SELECT()   spi_cs(0)
+#define SD_DESELECT() spi_cs(1)
+
+static unsigned long sd_addr(sd_card_t *card, unsigned long block) {
+    return card->hc ? block : block * SD_BLOCK_SIZE;
+}
+
+// Identification must run at the slow clock rate
+static char sd_txrx8(sd_card_t *card, char slow, char txd) {
+    return slow ? spi_txrx8_slow(card->spi, txd) : spi_txrx8(txd);
+}
+
+static unsigned char _sd_cmd(sd_card_t *card, char slow, char cmd, unsigned long arg, char crc) {
+    unsigned char r1 = 0xFF;
+    sd_txrx8(card, slow, 0xFF);
+    sd_txrx8(card, slow, 0x40 | cmd);
+    sd_txrx8(card, slow, arg >> 24);
+    sd_txrx8(card, slow, arg >> 16);
+    sd_txrx8(card, slow, arg >> 8);
+    sd_txrx8(card, slow, arg);
+    sd_txrx8(card, slow, crc);
+    // Response arrives within 8 bytes
+    for (int i = 0; i < 8; i++) {
+        r1 = sd_txrx8(card, slow, 0xFF);
+        if (!(r1 & 0x80)) { break; }
+    }
+    return r1;
+}
+
+static unsigned char sd_cmd(sd_card_t *card, char cmd, unsigned long arg) {
+    return _sd_cmd(card, 0, cmd, arg, 0x01);
+}
+
+static unsigned char sd_wait_token() {
+    unsigned char t = 0xFF;
+    for (long i = 0; i < 100000; i++) {
+        t = spi_txrx8(0xFF);
+        if (t != 0xFF) { break; }
+    }
+    return t;
+}
+
+static int sd_wait_ready() {
+    for (long i = 0; i < 500000; i++) {
+        if ((unsigned char)spi_txrx8(0xFF) == 0xFF) { return 0; }
+    }
+    return -1;
+}
+
+static unsigned long sd_decode_csd(unsigned char *csd) {
+    unsigned long c_size;
+    if ((csd[0] >> 6) == 1) { // CSD version 2.0: capacity is (C_SIZE+1) * 512 kB
+        c_size = ((unsigned long)(csd[7] & 0x3F) << 16) | (csd[8] << 8) | csd[9];
+        return (c_size + 1) << 10;
+    } else { // CSD version 1.0
+        int read_bl_len = csd[5] & 0x0F;
+        int c_size_mult = ((csd[9] & 0x03) << 1) | (csd[10] >> 7);
+        c_size = ((unsigned long)(csd[6] & 0x03) << 10) | (csd[7] << 2) | (csd[8] >> 6);
+        return (c_size + 1) << (c_size_mult + 2 + read_bl_len - 9);
+    }
+}
+
+int sd_init(sd_card_t *card, spi_state_t *spi) {
+    unsigned char r1, ocr[4], csd[16];
+    char v2;
+
+    card->hc = 0;
+    card->blocks = 0;
+    card->spi = spi;
+
+    // Send 80 clocks with card deselected to enter native mode
+    SD_DESELECT();
+    for (int i = 0; i < 10; i++) { spi_txrx8_slow(spi, 0xFF); }
+
+    // Identification runs at the slow clock rate
+    SD_SELECT();
+    r1 = _sd_cmd(card, 1, SD_CMD_GO_IDLE_STATE, 0, 0x95);
+    if (r1 != SD_R1_IDLE) { SD_DESELECT(); return -1; }
+
+    // Check for version 2.0 card (echoes voltage range and check pattern)
+    r1 = _sd_cmd(card, 1, SD_CMD_SEND_IF_COND, 0x000001AA, 0x87);
+    v2 = !(r1 & 0x04);
+    if (v2) {
+        for (int i = 0; i < 4; i++) { ocr[i] = spi_txrx8_slow(spi, 0xFF); }
+        if (ocr[2] != 0x01 || ocr[3] != 0xAA) { SD_DESELECT(); return -1; }
+    }
+
+    // Wait for card to leave idle state
+    for (long i = 0; i < 10000; i++) {
+        _sd_cmd(card, 1, SD_CMD_APP_CMD, 0, 0x01);
+        r1 = _sd_cmd(card, 1, SD_ACMD_SD_SEND_OP_COND, v2 ? 0x40000000 : 0, 0x01);
+        if (r1 != SD_R1_IDLE) { break; }
+    }
+    if (r1 != 0) { SD_DESELECT(); return -1; }
+
+    // Version 2.0 cards report block addressing in OCR CCS bit
+    if (v2) {
+        if (sd_cmd(card, SD_CMD_READ_OCR, 0)) { SD_DESELECT(); return -1; }
+        for (int i = 0; i < 4; i++) { ocr[i] = spi_txrx8(0xFF); }
+        card->hc = (ocr[0] & 0x40) != 0;
+    }
+
+    // Read CSD to get card capacity
+    if (sd_cmd(card, SD_CMD_SEND_CSD, 0) || sd_wait_token() != SD_TOKEN_START_BLOCK) {
+        SD_DESELECT();
+        return -1;
+    }
+    for (int i = 0; i < 16; i++) { csd[i] = spi_txrx8(0xFF); }
+    spi_txrx8(0xFF); spi_txrx8(0xFF); // Discard CRC
+    card->blocks = sd_decode_csd(csd);
+
+    SD_DESELECT();
+    spi_txrx8(0xFF);
+    return 0;
+}
+
+int sd_read_start(sd_card_t *card, unsigned long block) {
+    SD_SELECT();
+    if (sd_cmd(card, SD_CMD_READ_MULTIPLE_BLOCK, sd_addr(card, block))) {
+        SD_DESELECT();
+        return -1;
+    }
+    return 0;
+}
+
+int sd_read_next(sd_card_t *card, char *rxb, unsigned long count) {
+    for (; count > 0; count--, rxb += SD_BLOCK_SIZE) {
+        if (sd_wait_token() != SD_TOKEN_START_BLOCK) { return -1; }
+        spi_rx(card->spi, 0xFF, rxb, SD_BLOCK_SIZE);
+        spi_txrx8(0xFF); spi_txrx8(0xFF); // Discard CRC
+    }
+    return 0;
+}
+
+int sd_read_stop(sd_card_t *card) {
+    unsigned char r1;
+    spi_txrx8(0xFF);
+    spi_txrx8(0x40 | SD_CMD_STOP_TRANSMISSION);
+    spi_txrx8(0); spi_txrx8(0); spi_txrx8(0); spi_txrx8(0);
+    spi_txrx8(0x01);
+    spi_txrx8(0xFF); // Skip stuff byte
+    for (int i = 0; i < 8; i++) {
+        r1 = spi_txrx8(0xFF);
+        if (!(r1 & 0x80)) { break; }
+    }
+    if (sd_wait_ready()) { r1 = 0xFF; }
+    SD_DESELECT();
+    spi_txrx8(0xFF);
+    return r1 ? -1 : 0;
+}
+
+int sd_write_start(sd_card_t *card, unsigned long block) {
+    SD_SELECT();
+    if (sd_cmd(card, SD_CMD_WRITE_MULTIPLE_BLOCK, sd_addr(card, block))) {
+        SD_DESELECT();
+        return -1;
+    }
+    spi_txrx8(0xFF); // At least one byte before first data token (Nwr)
+    return 0;
+}
+
+int sd_write_next(sd_card_t *card, char *txb, unsigned long count) {
+    for (; count > 0; count--, txb += SD_BLOCK_SIZE) {
+        spi_txrx8(SD_TOKEN_START_MULTI_WRITE);
+        spi_tx(card->spi, txb, SD_BLOCK_SIZE);
+        spi_txrx8(0xFF); spi_txrx8(0xFF); // Dummy CRC
+        if ((spi_txrx8(0xFF) & SD_DATA_RESP_MASK) != SD_DATA_RESP_ACCEPTED) { return -1; }
+        if (sd_wait_ready()) { return -1; }
+    }
+    return 0;
+}
+
+int sd_write_stop(sd_card_t *card) {
+    int err;
+    spi_txrx8(SD_TOKEN_STOP_TRAN);
+    spi_txrx8(0xFF);
+    err = sd_wait_ready();
+    SD_DESELECT();
+    spi_txrx8(0xFF);
+    return err;
+}
@@ -0,0 +1,25 @@
+#ifndef _SD_H
+#define _SD_H
+
+#include "spi.h"
+
+#define SD_BLOCK_SIZE (512)
+
+// Card state, kept in caller's RAM (driver code and data are in ROM)
+typedef struct sd_card_s {
+    char hc; // Card uses block addressing (SDHC/SDXC)
+    unsigned long blocks;
+    spi_state_t *spi; // Bus the card is on
+} sd_card_t;
+
+int sd_init(sd_card_t *card, spi_state_t *spi);
+
+int sd_read_start(sd_card_t *card, unsigned long block);
+int sd_read_next(sd_card_t *card, char *rxb, unsigned long count);
+int sd_read_stop(sd_card_t *card);
+
+int sd_write_start(sd_card_t *card, unsigned long block);
+int sd_write_next(sd_card_t *card, char *txb, unsigned long count);
+int sd_write_stop(sd_card_t *card);
+
+#endif
@@ -10,14 +10,15 @@ static int _search_lt(char *buf, int stride, int threshold) {
 
 int _spi_hal_rx8_nops, _spi_hal_tx8_nops;
 int _spi_hal_rx16_nops, _spi_hal_tx16_nops;
+int _spi_hal_rx16u_nops, _spi_hal_tx16u_nops;
 int _spi_hal_rxtx8_nops;
 
 short *_spi_reg_rx16;
 char *_spi_reg_tx16;
 short *_spi_reg_rd16;
 
-int spi_init(int swap) {
-    short buf16[256];
+int spi_init(spi_state_t *s, int swap) {
+    short buf16[257]; // Extra word for odd-aligned calibration
     char *buf8 = (char*)&buf16;
 
     for (int i = 0; i < 8; i++) {
@@ -33,6 +34,14 @@ int spi_init(int swap) {
         _spi_hal_tx16_nops = i > 0 ? i - 1 : 0;
         if (!_search_lt(buf8, 2, 8)) { break; }
     }
+
+    s->hal_16u_en = 0;
+    for (int i = 0; i < 4; i++) {
+        spi_hal_rx16u(SPI_REG_TIMER16, buf8 + 1, 256, i);
+        _spi_hal_rx16u_nops = i;
+        _spi_hal_tx16u_nops = i > 0 ? i - 1 : 0;
+        if (!_search_lt(buf8 + 1, 2, 8)) { s->hal_16u_en = 1; break; }
+    }
     
     for (int i = 0; i < 8; i++) {
         spi_hal_rxtx8(SPI_REG_EMPTY, SPI_REG_TIMER16, buf8, buf8, 256, i);
@@ -43,6 +52,7 @@ int spi_init(int swap) {
     _spi_reg_rx16 = swap ? SPI_REG_RX16S : SPI_REG_RX16;
     _spi_reg_tx16 = swap ? SPI_REG_TX16S : SPI_REG_TX16;
     _spi_reg_rd16 = swap ? SPI_REG_RD16S : SPI_REG_RD16;
+    s->st16_txd = -1;
     return 0;
 }
 
@@ -51,8 +61,9 @@ void spi_cs(int cs) {
     else { SPI_REG_CSR_CLR_CS(); }
 }
 
-char spi_txrx8_slow(char txd) {
+char spi_txrx8_slow(spi_state_t *s, char txd) {
     char rxd = 0;
+    s->st16_txd = -1; // MOSI is driven through ST16 here
     for (int i = 7; i >= 0; i--) {
         spi_delay(64);
         SPI_REG_CSR_CLR_SCK();
@@ -77,49 +88,66 @@ char spi_rxtx8(char txd) {
     return rxd;
 }
 
-#define UNROLL_LENGTH 5
+#define SPI_HAL_MAX_WORDS (256)
+
+static void spi_set_st16(spi_state_t *s, char txd) {
+    if (s->st16_txd == (unsigned char)txd) { return; }
+    reg_write16(SPI_REG_ST16, smear8to32(txd));
+    s->st16_txd = (unsigned char)txd;
+}
+
+void spi_rx(spi_state_t *s, char txd, char *rxb, unsigned int length) {
+    unsigned int words;
+    int odd;
 
-void spi_rx(char txd, char *rxb, unsigned int length) {
     if (length == 0) { return; } // Return if length 0
 
-    // Word-align rx pointer by transferring 0/1 bytes
-    if ((int)rxb & 1) {
+    // Set tx pattern if changed
+    spi_set_st16(s, txd);
+
+    // Word-align rx pointer by transferring 1 byte if no odd-aligned kernel
+    if (((int)rxb & 1) && !s->hal_16u_en) {
         *(rxb++) = spi_rxtx8(txd);
         length--;
     }
-
-    // Set tx pattern
-    reg_write16(SPI_REG_ST16, smear8to32(txd));
-    
-    // Transfer all but 0-65 bytes
-    for (int i = length >> (UNROLL_LENGTH +1); i > 0; i--) {
-        // Transfer 2^UNROLL_LENGTH words (2 * 2^UNROLL_LENGTH bytes)
-        spi_hal_rx16(_spi_reg_rx16, rxb, UNROLL_LENGTH, _spi_hal_rx16_nops);
+    words = length >> 1;
+    odd = (int)rxb & 1;
+
+    // Transfer all words, odd-aligned buffer is merged in registers
+    while (words > 0) {
+        unsigned int n = words > SPI_HAL_MAX_WORDS ? SPI_HAL_MAX_WORDS : words;
+        if (odd) { spi_hal_rx16u(_spi_reg_rx16, rxb, n, _spi_hal_rx16u_nops); }
+        else { spi_hal_rx16(_spi_reg_rx16, rxb, n, _spi_hal_rx16_nops); }
+        rxb += n << 1;
+        words -= n;
     }
-    
-    // Transfer remaining 1-32 words (2-64 bytes)
-    spi_hal_rx16(_spi_reg_rx16, rxb, length >> 1, _spi_hal_rx16_nops);
 
     // Transfer remaining byte if any
     if (length & 1) { *(rxb++) = spi_rxtx8(txd); }
 }
 
-void spi_tx(char *txb, unsigned int length) {
+void spi_tx(spi_state_t *s, char *txb, unsigned int length) {
+    unsigned int words;
+    int odd;
+
     if (length == 0) { return; } // Return if length 0
 
-    // Word-align tx pointer by transferring 0/1 bytes
-    if ((int)txb & 1) {
+    // Word-align tx pointer by transferring 1 byte if no odd-aligned kernel
+    if (((int)txb & 1) && !s->hal_16u_en) {
         spi_rxtx8(*(txb++));
         length--;
     }
-
-    // Transfer all but 0-65 bytes
-    for (; length > UNROLL_LENGTH; length -= UNROLL_LENGTH) {
-        spi_hal_tx16(_spi_reg_tx16, txb, UNROLL_LENGTH, _spi_hal_tx16_nops);
+    words = length >> 1;
+    odd = (int)txb & 1;
+
+    // Transfer all words, odd-aligned buffer is merged in registers
+    while (words > 0) {
+        unsigned int n = words > SPI_HAL_MAX_WORDS ? SPI_HAL_MAX_WORDS : words;
+        if (odd) { spi_hal_tx16u(_spi_reg_tx16, txb, n, _spi_hal_tx16u_nops); }
+        else { spi_hal_tx16(_spi_reg_tx16, txb, n, _spi_hal_tx16_nops); }
+        txb += n << 1;
+        words -= n;
     }
-    
-    // Transfer remaining 1-32 words (2-64 bytes)
-    spi_hal_tx16(_spi_reg_tx16, txb, length >> 1, _spi_hal_tx16_nops);
 
     // Transfer remaining byte if any
     if (length & 1) { spi_rxtx8(*(txb++)); }
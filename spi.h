@@ -3,16 +3,22 @@
 
 #include <stddef.h>
 
-int spi_init();
+// Transfer state, kept in caller's RAM (driver code and data are in ROM)
+typedef struct spi_state_s {
+    int st16_txd; // Pattern last written to ST16, -1 if unknown
+    char hal_16u_en; // Odd-aligned kernels calibrated within their nops
+} spi_state_t;
+
+int spi_init(spi_state_t *s, int swap);
 
 void spi_cs(int cs);
 
-char spi_txrx8_slow(char txd);
+char spi_txrx8_slow(spi_state_t *s, char txd);
 char spi_txrx8(char txd);
 char spi_rxtx8(char txd);
 
-void spi_tx(char *txb, unsigned int length);
-void spi_rx(char txd, char *rxb, unsigned int length);
+void spi_tx(spi_state_t *s, char *txb, unsigned int length);
+void spi_rx(spi_state_t *s, char txd, char *rxb, unsigned int length);
 
 char spi_rd8();
 short spi_rd16();
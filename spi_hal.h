@@ -58,6 +58,14 @@ static inline void spi_hal_rx16(void *reg, void *rx, int length, int nops) {
     _spi_hal_rx16(reg, rx, 0, length, nops, 0);
 }
 
+// Odd-aligned rx buffer, writes 2*length bytes starting at rx
+// (rewrites byte before rx with its own value)
+#pragma parameter _spi_hal_rx16u(__A0, __A2, __A4, __D0, __D1, __D2)
+extern void _spi_hal_rx16u(void *reg, void *rx, void *tmp, int length, int nops, int tmp2);
+static inline void spi_hal_rx16u(void *reg, void *rx, int length, int nops) { 
+    _spi_hal_rx16u(reg, rx, 0, length, nops, 0);
+}
+
 #pragma parameter _spi_hal_tx8(__A0, __A3, __A4, __D0, __D1, __D2)
 extern void _spi_hal_tx8(void *reg, void *tx, void *tmp, int length, int nops, int tmp2);
 static inline void spi_hal_tx8(void *reg, void *tx, int length, int nops) { 
@@ -70,6 +78,14 @@ static inline void spi_hal_tx16(void *reg, void *tx, int length, int nops) {
     _spi_hal_tx16(reg, tx, 0, length, nops, 0);
 }
 
+// Odd-aligned tx buffer, sends 2*length bytes starting at tx
+// (reads one byte past the end, in the same aligned word)
+#pragma parameter _spi_hal_tx16u(__A0, __A3, __A4, __D0, __D1, __D2)
+extern void _spi_hal_tx16u(void *reg, void *tx, void *tmp, int length, int nops, int tmp2);
+static inline void spi_hal_tx16u(void *reg, void *tx, int length, int nops) { 
+    _spi_hal_tx16u(reg, tx, 0, length, nops, 0);
+}
+
 #pragma parameter _spi_hal_rxtx8(__A0, __A1, __A2, __A3, __A4, __D0, __D1, __D2)
 extern void _spi_hal_rxtx8(void *reg, void *read, void *rx, void *tx, void *tmp, int length, int nops, int tmp2);
 static inline void spi_hal_rxtx8(void *reg, void *read, void *rx, void *tx, int length, int nops) { 
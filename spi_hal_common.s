@@ -9,7 +9,7 @@
 * D2 - clobbered (save SR)
 * D3 - clobbered (save CACR)
 
-.macro spi_call table, maxnops
+.macro spi_call table, maxnops, setup
     * Limit %D0 (length) to 1-256
     subq.w #1, %D0
     andi.l #0xFF, %D0
@@ -70,6 +70,9 @@
     * Move back into CACR
     movec.l %D1, %CACR
 
+    * Run kernel setup (may use %D1, must not touch %D0)
+    \setup
+
     * Jump to entry point
     * (table + table[length*4 + nops*4*256])
     jmp (\table - ., %PC, %D0.l)
@@ -88,10 +91,11 @@
     .endif
 .endm
 
-.macro unroll_table macro, nops, n
+.macro unroll_table macro, nops, n, finish
     .rept \n
         \macro \nops
     .endr
+    \finish
     move.w %D2, %SR
     movec.l %D3, %CACR
     rts
@@ -0,0 +1,61 @@
+* spi calling convention
+* A0 - ROM register
+* A1 - readback address
+* A2 - RX buffer
+* A3 - TX buffer
+* A4 - clobbered
+* D0 - length (clobbered)
+* D1 - nops (clobbered)
+
+* RX buffer must be odd-aligned. Words are merged in registers so that
+* all stores to the buffer are word-aligned. The byte ahead of the
+* buffer is read and written back unchanged.
+*
+* Only 0-3 nops are provided to keep the unrolled tables small, the
+* longer iteration already spaces out the reads. If that isn't enough
+* spi_init leaves these kernels disabled.
+
+.global _spi_hal_rx16u
+
+.include "spi_hal_common.s"
+
+.macro _spi_hal_rx16u_setup
+    * Start at aligned word holding first byte, carry in %D1 high byte
+    subq.l #1, %A2
+    move.w (%A2), %D1
+.endm
+
+.macro _spi_hal_rx16u_iteration nops
+    move.w (%A0), %D0
+    ror.w #8, %D0
+    move.b %D0, %D1
+    move.w %D1, (%A2)+
+    move.w %D0, %D1
+    .rept \nops
+        nop
+    .endr
+.endm
+
+.macro _spi_hal_rx16u_finish
+    * Store carried low byte of last word
+    ror.w #8, %D1
+    move.b %D1, (%A2)
+.endm
+
+.align 16
+_spi_hal_rx16u:
+    spi_call _spi_hal_rx16u_lookup, 3, _spi_hal_rx16u_setup
+.align 16
+_spi_hal_rx16u_lookup:
+    lookup_table _spi_hal_rx16u_lookup, _spi_hal_rx16u_table_0, 10, 256
+    lookup_table _spi_hal_rx16u_lookup, _spi_hal_rx16u_table_1, 12, 256
+    lookup_table _spi_hal_rx16u_lookup, _spi_hal_rx16u_table_2, 14, 256
+    lookup_table _spi_hal_rx16u_lookup, _spi_hal_rx16u_table_3, 16, 256
+.align 16
+_spi_hal_rx16u_table_0: unroll_table _spi_hal_rx16u_iteration, 0, 256, _spi_hal_rx16u_finish
+.align 16
+_spi_hal_rx16u_table_1: unroll_table _spi_hal_rx16u_iteration, 1, 256, _spi_hal_rx16u_finish
+.align 16
+_spi_hal_rx16u_table_2: unroll_table _spi_hal_rx16u_iteration, 2, 256, _spi_hal_rx16u_finish
+.align 16
+_spi_hal_rx16u_table_3: unroll_table _spi_hal_rx16u_iteration, 3, 256, _spi_hal_rx16u_finish
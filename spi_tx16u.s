@@ -0,0 +1,56 @@
+* spi calling convention
+* A0 - ROM register
+* A1 - readback address
+* A2 - RX buffer
+* A3 - TX buffer
+* A4 - clobbered
+* D0 - length (clobbered)
+* D1 - nops (clobbered)
+
+* TX buffer must be odd-aligned. Words are fetched aligned and shifted
+* together in registers before being sent. The last word fetched also
+* holds the byte just past the buffer, which is read but not sent.
+* It is in the same aligned word as the last byte, so it can't fault.
+*
+* Only 0-3 nops are provided to keep the unrolled tables small, the
+* longer iteration already spaces out the writes. If that isn't enough
+* spi_init leaves these kernels disabled.
+
+.global _spi_hal_tx16u
+
+.include "spi_hal_common.s"
+
+.macro _spi_hal_tx16u_setup
+    * Carry first byte in %D1 high byte, %A3 is now word-aligned
+    move.b (%A3)+, %D1
+    lsl.w #8, %D1
+.endm
+
+.macro _spi_hal_tx16u_iteration nops
+    move.w (%A3)+, %D0
+    ror.w #8, %D0
+    move.b %D0, %D1
+    move.b (%A0, %D1.W), %D1
+    move.w %D0, %D1
+    .rept \nops
+    nop
+    .endr
+.endm
+
+.align 16
+_spi_hal_tx16u:
+    spi_call _spi_hal_tx16u_lookup, 3, _spi_hal_tx16u_setup
+.align 16
+_spi_hal_tx16u_lookup:
+    lookup_table _spi_hal_tx16u_lookup, _spi_hal_tx16u_table_0, 12, 256
+    lookup_table _spi_hal_tx16u_lookup, _spi_hal_tx16u_table_1, 14, 256
+    lookup_table _spi_hal_tx16u_lookup, _spi_hal_tx16u_table_2, 16, 256
+    lookup_table _spi_hal_tx16u_lookup, _spi_hal_tx16u_table_3, 18, 256
+.align 16
+_spi_hal_tx16u_table_0: unroll_table _spi_hal_tx16u_iteration, 0, 256
+.align 16
+_spi_hal_tx16u_table_1: unroll_table _spi_hal_tx16u_iteration, 1, 256
+.align 16
+_spi_hal_tx16u_table_2: unroll_table _spi_hal_tx16u_iteration, 2, 256
+.align 16
+_spi_hal_tx16u_table_3: unroll_table _spi_hal_tx16u_iteration, 3, 256